@@ -1,6 +1,8 @@
 #include <algorithm>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <vector>
 #include <unistd.h>
 
 #include <boost/program_options.hpp>
@@ -19,6 +21,14 @@ int main(int argc, char* argv[]) {
 		("valid_words_path,w", boost_opts::value<std::string>()->required(), "Path of the text file containing words considered valid. May instead be given as the first positional argument. [required]")
 		("letter_scores_path,l", boost_opts::value<std::string>()->default_value(""), "Path of the text file containing the score to be given for each letter. If unspecified, letter scores will be generated automatically using the list of valid words. [optional]")
 		("board_dimension,n", boost_opts::value<int>()->default_value(16), "The side length the square board should have. [optional]")
+		("extra_words_paths,x", boost_opts::value<std::vector<std::string>>()->composing()->default_value({}, ""), "Paths of further word lists for analysing positions. The list given by valid_words_path has lexicon id 0, and these are numbered from 1 in the order given. May be repeated. [optional]")
+		("positions_path,p", boost_opts::value<std::string>()->default_value(""), "Path of a file of saved positions to analyse instead of playing a game, or \"-\" to read them from standard input. Each line holds a board (rows separated by '/', '_' for empty cells), a rack ('*' for blank tiles), and optionally a lexicon id. [optional]")
+		("top_count,t", boost_opts::value<int>()->default_value(5), "The number of best plays to report for each analysed position. [optional]")
+		("threads,j", boost_opts::value<int>()->default_value(0), "The number of positions to analyse in parallel. If 0, one per hardware thread. [optional]")
+		("seed,s", boost_opts::value<Game::seed_type>(), "The seed for the random choice of tiles. Giving the same seed (and the same word list and letter scores) reproduces a game. If unspecified, a seed will be chosen at random. [optional]")
+		("log_path,o", boost_opts::value<std::string>()->default_value(""), "Path of a file to append a log of the game's plays to, so that it can be replayed. [optional]")
+		("replay_paths,r", boost_opts::value<std::vector<std::string>>()->multitoken()->default_value({}, ""), "Paths of logged games to replay instead of playing a game. The same word list and letter scores used to play them must be given. [optional]")
+		("reference_generator,c", boost_opts::value<std::string>()->default_value("best_overall"), "When replaying games, the move generator Halfred's logged plays are compared with: best_overall (the one used in games), best_plays (the one used to analyse positions), or none to skip the comparison. [optional]")
 		("verbose,v", boost_opts::bool_switch(), "Display Hal's (the computer's) available letters as well as your own each turn.")
 		("help,h", boost_opts::bool_switch(), "Print help message and exit. Overrides all other options.")
 	;
@@ -30,5 +40,35 @@ int main(int argc, char* argv[]) {
 	}
 	boost_opts::notify(opt_vals);
 
-	return play_game(opt_vals["valid_words_path"].as<std::string>(), opt_vals["letter_scores_path"].as<std::string>(), opt_vals["board_dimension"].as<int>(), opt_vals["verbose"].as<bool>());
+	if (!opt_vals["positions_path"].as<std::string>().empty()) {
+		std::vector<std::string> valid_words_paths{opt_vals["valid_words_path"].as<std::string>()};
+		const std::vector<std::string>& extra_words_paths = opt_vals["extra_words_paths"].as<std::vector<std::string>>();
+		valid_words_paths.insert(valid_words_paths.end(), extra_words_paths.begin(), extra_words_paths.end());
+		return analyse_positions(valid_words_paths, opt_vals["positions_path"].as<std::string>(), opt_vals["letter_scores_path"].as<std::string>(), opt_vals["board_dimension"].as<int>(), std::max(opt_vals["top_count"].as<int>(), 0), std::max(opt_vals["threads"].as<int>(), 0));
+	}
+
+	if (!opt_vals["replay_paths"].as<std::vector<std::string>>().empty()) {
+		const std::string& reference_name = opt_vals["reference_generator"].as<std::string>();
+		Game::move_generator reference;
+		if (reference_name == "best_overall") {
+			reference = Game::move_generator::best_overall;
+		}
+		else if (reference_name == "best_plays") {
+			reference = Game::move_generator::best_plays;
+		}
+		else if (reference_name == "none") {
+			reference = Game::move_generator::none;
+		}
+		else {
+			std::cerr << "Error: Unknown move generator \"" << reference_name << "\"." << std::endl;
+			return 1;
+		}
+		return replay_games(opt_vals["valid_words_path"].as<std::string>(), opt_vals["replay_paths"].as<std::vector<std::string>>(), opt_vals["letter_scores_path"].as<std::string>(), reference);
+	}
+
+	std::optional<Game::seed_type> seed{};
+	if (opt_vals.count("seed")) {
+		seed = opt_vals["seed"].as<Game::seed_type>();
+	}
+	return play_game(opt_vals["valid_words_path"].as<std::string>(), opt_vals["letter_scores_path"].as<std::string>(), opt_vals["board_dimension"].as<int>(), opt_vals["verbose"].as<bool>(), seed, opt_vals["log_path"].as<std::string>());
 }
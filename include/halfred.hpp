@@ -1,18 +1,27 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <numeric>
+#include <optional>
 #include <random>
 #include <regex>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 namespace halfred {
@@ -63,6 +72,7 @@ namespace halfred {
 
 		static constexpr size_type letter_space_size = 26;
 		using letter_tally = std::array<unsigned int, letter_space_size + 1>;
+		using seed_type = std::mt19937::result_type;
 		struct play {
 			size_type row;
 			size_type col;
@@ -72,6 +82,107 @@ namespace halfred {
 			letter_tally letters_used;
 		};
 
+		// The valid words in sorted order, along with each word's total letter score and letter tally, computed once when the lexicon is built.
+		// These are kept in separate arrays (rather than an array of structs) so that each part of the search only touches what it needs.
+		class Lexicon {
+			public:
+			using word_tally = std::array<unsigned char, letter_space_size>;
+
+			// If no letter scores are given, each letter is scored by how rare it is among the words.
+			Lexicon(std::vector<std::string> words, std::optional<letter_tally> letter_scores = std::nullopt) : words_(std::move(words)) {
+				std::sort(words_.begin(), words_.end());
+				word_tallies_.reserve(words_.size());
+				letter_tally letter_counts{};
+				unsigned int total_letters = 0;
+				for (const std::string& word : words_) {
+					word_tally tally{};
+					for (const char& le : word) {
+						++tally.at(letter_to_index(le));
+						++letter_counts.at(letter_to_index(le));
+						++total_letters;
+					}
+					word_tallies_.push_back(tally);
+				}
+
+				if (letter_scores) {
+					letter_scores_ = *letter_scores;
+				}
+				else {
+					for (unsigned int i = 0; i < letter_space_size; ++i) {
+						// A letter that no word uses is scored as if it appeared once, making it (jointly) the highest scoring letter.
+						letter_scores_.at(i) = std::max(total_letters / std::max(letter_counts.at(i), 1U), 1U);
+					}
+					letter_scores_.back() = 0;
+				}
+
+				word_scores_.reserve(words_.size());
+				for (const word_tally& tally : word_tallies_) {
+					unsigned int score = 0;
+					for (size_type i = 0; i < letter_space_size; ++i) {
+						score += tally.at(i) * letter_scores_.at(i);
+					}
+					word_scores_.push_back(score);
+				}
+			}
+
+			// Return the index of a word, or size() if it is not valid.
+			size_type index_of(std::string_view word) const {
+				auto position = std::lower_bound(words_.begin(), words_.end(), word);
+				if (position == words_.end() || *position != word) {
+					return size();
+				}
+				return position - words_.begin();
+			}
+
+			// Whether a word could be spelled from the given letters, using blank tiles (the last count) for any that are missing.
+			bool could_spell(size_type word_index, const letter_tally& letter_counts) const {
+				// This runs for every word in every row and column, so it indexes the arrays' data directly (which is cheap even without optimisation) and stops as soon as the blanks run out.
+				const unsigned char* tally = word_tallies_[word_index].data();
+				const unsigned int* counts = letter_counts.data();
+				const unsigned int blank_count = counts[letter_space_size];
+				unsigned int missing = 0;
+				for (size_type i = 0; i < letter_space_size; ++i) {
+					if (tally[i] > counts[i]) {
+						missing += tally[i] - counts[i];
+						if (missing > blank_count) {
+							return false;
+						}
+					}
+				}
+				return true;
+			}
+
+			size_type size() const noexcept {
+				return words_.size();
+			}
+
+			const std::string& word(size_type word_index) const {
+				return words_.at(word_index);
+			}
+
+			// The sum of the scores of a word's letters.
+			unsigned int word_score(size_type word_index) const {
+				return word_scores_.at(word_index);
+			}
+
+			const std::vector<std::string>& words() const noexcept {
+				return words_;
+			}
+
+			const letter_tally& letter_scores() const noexcept {
+				return letter_scores_;
+			}
+
+			private:
+			std::vector<std::string> words_;
+			std::vector<unsigned int> word_scores_;
+			std::vector<word_tally> word_tallies_;
+			letter_tally letter_scores_;
+		};
+
+		// The ways Halfred can choose a play, which replayed plays can be checked against.
+		enum class move_generator {none, best_overall, best_plays};
+
 		static constexpr unsigned short lowercase_offset = 97;
 		static constexpr size_type available_letter_sum = 8;
 		static constexpr char empty = '_';
@@ -84,42 +195,25 @@ namespace halfred {
 		// Attempting to use a default initialized Game causes undefined behaviour.
 		Game() : verbose_(false) {}
 
-		Game(std::vector<std::string> valid_words, letter_tally letter_scores, size_type board_dimension, bool verbose) :
-				letter_scores_(letter_scores),
-				valid_words_(valid_words),
+		// If no seed is given, one is chosen at random.
+		Game(std::shared_ptr<const Lexicon> lexicon, size_type board_dimension, bool verbose, std::optional<seed_type> seed = std::nullopt) :
+				lexicon_(std::move(lexicon)),
 				board_dimension_(board_dimension),
 				verbose_(verbose) {
-			init();
+			init(seed);
 		}
 
-		Game(std::vector<std::string> valid_words, size_type board_dimension, bool verbose) :
-				valid_words_(valid_words),
-				board_dimension_(board_dimension),
-				verbose_(verbose) {
-
-			letter_tally letter_counts{};
-			unsigned int total_letters = 0;
-			for (const std::string& word : valid_words_) {
-				for (const char& le : word) {
-					++letter_counts.at(letter_to_index(le));
-					++total_letters;
-				}
-			}
+		Game(std::vector<std::string> valid_words, letter_tally letter_scores, size_type board_dimension, bool verbose, std::optional<seed_type> seed = std::nullopt) :
+				Game(std::make_shared<const Lexicon>(std::move(valid_words), letter_scores), board_dimension, verbose, seed) {}
 
-			for (unsigned int i = 0; i < letter_space_size; ++i) {
-				letter_scores_.at(i) = std::max(total_letters / letter_counts.at(i), 1U);
-			}
-			letter_scores_.back() = 0.f;
-
-			init();
-		}
+		Game(std::vector<std::string> valid_words, size_type board_dimension, bool verbose, std::optional<seed_type> seed = std::nullopt) :
+				Game(std::make_shared<const Lexicon>(std::move(valid_words)), board_dimension, verbose, seed) {}
 
 		Game(const Game& other) = default;
 		Game(Game&& other) = default;
 
 		Game& operator=(const Game& other) {
-			valid_words_ = other.valid_words_;
-			letter_scores_ = other.letter_scores_;
+			lexicon_ = other.lexicon_;
 			board_dimension_ = other.board_dimension_;
 			verbose_ = other.verbose_;
 			board_ = other.board_;
@@ -128,7 +222,9 @@ namespace halfred {
 			hal_available_letter_counts_ = other.hal_available_letter_counts_;
 			person_score_ = other.person_score_;
 			hal_score_ = other.hal_score_;
-			random_bit_gen_ = std::mt19937(random_dev_());
+			seed_ = other.seed_;
+			// Copy the generator's state too, so that the copy goes on to draw the same letters.
+			random_bit_gen_ = other.random_bit_gen_;
 			random_letter_dist_ = other.random_letter_dist_;
 			return *this;
 		}
@@ -157,7 +253,8 @@ namespace halfred {
 				}
 			}
 			out << std::endl;
-			apply_play(person_play, person_available_letter_counts_, person_score_);
+			letter_tally drawn = apply_play(person_play, person_available_letter_counts_, person_score_);
+			log_play(person_record, person_play, drawn);
 			return true;
 		}
 
@@ -168,11 +265,151 @@ namespace halfred {
 				out << "Halfred does not see any possible plays. How about you?" << std::endl << std::endl;
 				return false;
 			}
-			out << "Halfred played \"" << hal_play.word << "\" at " << hal_play.row + 1 << index_to_letter(hal_play.col) << (hal_play.across ? 'a' : 'd') << " for " << hal_play.score << " points." << std::endl << std::endl;
-			apply_play(hal_play, hal_available_letter_counts_, hal_score_);
+			out << "Halfred played \"" << hal_play.word << "\" at " << location_string(hal_play) << " for " << hal_play.score << " points." << std::endl << std::endl;
+			letter_tally drawn = apply_play(hal_play, hal_available_letter_counts_, hal_score_);
+			log_play(hal_record, hal_play, drawn);
 			return true;
 		}
 
+		// Replace the board and Halfred's tiles with those of a saved position so that its plays can be analysed.
+		// The board is given as rows separated by '/', using '_' for empty cells. The rack uses '*' for blank tiles.
+		// Returns an explanation if the position is invalid, or an empty string otherwise.
+		std::string load_position(const std::string& board, const std::string& rack) {
+			std::vector<std::vector<char>> new_board{};
+			new_board.reserve(board_dimension_);
+			std::istringstream rows{board};
+			std::string row;
+			while (std::getline(rows, row, '/')) {
+				if (row.size() != board_dimension_) {
+					return std::string{"Every row of the board must have "} + std::to_string(board_dimension_) + " cells.";
+				}
+				for (char& ch : row) {
+					ch = lower(ch);
+					if (ch != empty && letter_to_index(ch) >= letter_space_size) {
+						return std::string{"The board contains the invalid character '"} + ch + "'.";
+					}
+				}
+				new_board.emplace_back(row.begin(), row.end());
+			}
+			if (new_board.size() != board_dimension_) {
+				return std::string{"The board must have "} + std::to_string(board_dimension_) + " rows.";
+			}
+
+			letter_tally rack_counts{};
+			for (const char& ch : rack) {
+				const char le = lower(ch);
+				// letter_to_index assumes the char is lowercase ASCII, so underflow may occur here.
+				if (le != wild && letter_to_index(le) >= letter_space_size) {
+					return std::string{"The rack contains the invalid character '"} + ch + "'.";
+				}
+				++rack_counts.at(letter_to_index(le));
+			}
+
+			board_ = std::move(new_board);
+			hal_available_letter_counts_ = rack_counts;
+			return "";
+		}
+
+		// Find up to count of the best valid plays anywhere on the board, best first.
+		std::vector<play> best_plays(size_type count) {
+			std::vector<play> plays{};
+			if (count == 0) {
+				return plays;
+			}
+			turn_arena_.release();
+			std::pmr::vector<candidate> best_options{&turn_arena_};
+			best_options.reserve(count + 1);
+			auto consider = [&best_options, count](const candidate& c) {
+				if (best_options.size() == count && c.score <= best_options.back().score) {
+					return;
+				}
+				// The same play may be found starting from more than one of the letters already on the board.
+				if (std::any_of(best_options.begin(), best_options.end(), [&c](const candidate& other){return other.row == c.row && other.col == c.col && other.across == c.across && other.word_index == c.word_index;})) {
+					return;
+				}
+				auto position = std::upper_bound(best_options.begin(), best_options.end(), c.score, [](int score, const candidate& other){return score > other.score;});
+				best_options.insert(position, c);
+				if (best_options.size() > count) {
+					best_options.pop_back();
+				}
+			};
+			for (size_type row_i = 0; row_i < board_dimension_; ++row_i) {
+				plays_in_row(row_i, true, consider);
+				plays_in_row(row_i, false, consider);
+			}
+
+			plays.reserve(best_options.size());
+			for (const candidate& c : best_options) {
+				plays.push_back(to_play(c));
+			}
+			return plays;
+		}
+
+		// Append a record of every play made from now on to log, starting with the seed needed to reproduce the game.
+		void start_log(std::ostream& log) {
+			log_ = &log;
+			*log_ << seed_ << ' ' << board_dimension_ << std::endl;
+		}
+
+		// Make a play read back from a log (see log_play), without prompting anyone.
+		// If the play is Halfred's, it is first compared with the play the reference generator would choose now (unless the reference is none).
+		// Returns a description of every way in which replaying the record differs from what was recorded, or an empty string if it matches.
+		std::string replay(const std::string& record, move_generator reference = move_generator::best_overall) {
+			std::istringstream fields{record};
+			char player;
+			std::string location;
+			play p = null_play;
+			std::string letters_used;
+			std::string letters_drawn;
+			int score;
+			if (!(fields >> player >> location >> p.word >> letters_used >> letters_drawn >> score) || (player != person_record && player != hal_record)) {
+				return "The record is malformed.";
+			}
+			parse_location(p, location);
+			if (p.row >= board_dimension_ || p.col >= board_dimension_) {
+				return "The record has an invalid location.";
+			}
+
+			std::string differences{};
+			const bool is_hal = player == hal_record;
+			if (is_hal && reference != move_generator::none) {
+				play hal_play = null_play;
+				if (reference == move_generator::best_overall) {
+					hal_play = best_overall();
+				}
+				else {
+					std::vector<play> hal_plays = best_plays(1);
+					if (!hal_plays.empty()) {
+						hal_play = hal_plays.front();
+					}
+				}
+				if (hal_play.word != p.word || hal_play.row != p.row || hal_play.col != p.col || hal_play.across != p.across) {
+					differences += "Halfred would now play \"" + hal_play.word + "\" at " + location_string(hal_play) + " for " + std::to_string(hal_play.score) + " points. ";
+				}
+			}
+
+			letter_tally& available_letter_counts = is_hal ? hal_available_letter_counts_ : person_available_letter_counts_;
+			std::string possible_error = evaluate_play(p, available_letter_counts);
+			if (p.score < 0) {
+				return differences + "The play cannot be made. " + possible_error;
+			}
+			if (p.score != score) {
+				differences += "The play scores " + std::to_string(p.score) + " points. ";
+			}
+			if (tally_string(p.letters_used) != letters_used) {
+				differences += "The play uses " + tally_string(p.letters_used) + ". ";
+			}
+			letter_tally drawn = apply_play(p, available_letter_counts, is_hal ? hal_score_ : person_score_);
+			if (tally_string(drawn) != letters_drawn) {
+				differences += "The tiles drawn are " + tally_string(drawn) + ". ";
+			}
+			// Remove the space after the last difference.
+			if (!differences.empty()) {
+				differences.pop_back();
+			}
+			return differences;
+		}
+
 		// Return the number of occupied cells on the board.
 		bool board_occupied_count() {
 			size_type count = 0;
@@ -232,11 +469,15 @@ namespace halfred {
 		}
 
 		std::vector<std::string> valid_words() const noexcept {
-			return valid_words_;
+			return lexicon_->words();
 		}
 
 		letter_tally letter_scores() const noexcept {
-			return letter_scores_;
+			return lexicon_->letter_scores();
+		}
+
+		std::shared_ptr<const Lexicon> lexicon() const noexcept {
+			return lexicon_;
 		}
 
 		size_type board_dimension() const noexcept {
@@ -247,6 +488,10 @@ namespace halfred {
 			return verbose_;
 		}
 
+		seed_type seed() const noexcept {
+			return seed_;
+		}
+
 		std::vector<std::vector<char>> board() const noexcept {
 			return board_;
 		}
@@ -273,44 +518,66 @@ namespace halfred {
 
 		friend void swap(Game& first, Game& second);
 		static std::string clean_word(std::string word);
+		static std::string location_string(const play& p);
+		static std::string tally_string(const letter_tally& tally);
 
 		protected:
-		std::vector<std::string> valid_words_;
-		letter_tally letter_scores_;
+		// A play considered while Halfred searches for the best one. It refers to its word by its index in the lexicon so that the search does not copy strings.
+		struct candidate {
+			size_type row;
+			size_type col;
+			bool across;
+			size_type word_index;
+			int score;
+			letter_tally letters_used;
+		};
+		static constexpr candidate null_candidate{0, 0, true, 0, -1, letter_tally{}};
+
+		// Shared by every game using the same words, since it does not change during a game.
+		std::shared_ptr<const Lexicon> lexicon_;
 		size_type board_dimension_;
 		bool verbose_;
 
 		std::vector<std::vector<char>> board_;
 		std::array<float, letter_space_size + 1> letter_weights_;
 		std::random_device random_dev_;
+		seed_type seed_;
 		std::mt19937 random_bit_gen_;
 		std::uniform_real_distribution<float> random_letter_dist_;
 
+		// Scratch memory for Halfred's searches, released at the start of each one rather than freed piece by piece.
+		std::array<std::byte, 4096> turn_buffer_;
+		std::pmr::monotonic_buffer_resource turn_arena_{turn_buffer_.data(), turn_buffer_.size()};
+
 		// + 1 is for blank tiles.
 		letter_tally person_available_letter_counts_;
 		letter_tally hal_available_letter_counts_;
 		unsigned int person_score_;
 		unsigned int hal_score_;
+		// Where plays are recorded, if anywhere.
+		std::ostream* log_ = nullptr;
 
 		private:
-		void init() {
+		static constexpr char person_record = 'p';
+		static constexpr char hal_record = 'h';
+
+		void init(std::optional<seed_type> seed) {
 			assert(board_dimension_ <= max_board_dimension);
 
-			std::sort(valid_words_.begin(), valid_words_.end());
+			person_available_letter_counts_.fill(0);
+			hal_available_letter_counts_.fill(0);
 
-			for (size_type i = 0; i < letter_space_size; ++i) {
-				person_available_letter_counts_.at(i) = 0;
-				hal_available_letter_counts_.at(i) = 0;
-			}
-
-			letter_weights_.front() = 1.f / letter_scores_.front();
+			const letter_tally& letter_scores = lexicon_->letter_scores();
+			letter_weights_.front() = 1.f / letter_scores.front();
 			for (size_type i = 1; i < letter_space_size; ++i) {
-				letter_weights_.at(i) = letter_weights_.at(i - 1) + (1.f / letter_scores_.at(i));
+				letter_weights_.at(i) = letter_weights_.at(i - 1) + (1.f / letter_scores.at(i));
 			}
 			// Let blank tiles have a weight equal to the average of all letters.
 			float z_weight = letter_weights_.at(letter_space_size - 1);
 			letter_weights_.back() = z_weight + (z_weight / letter_space_size);
-			random_bit_gen_ = std::mt19937(random_dev_());
+			// Only read the random device if no seed was given.
+			seed_ = seed ? *seed : random_dev_();
+			random_bit_gen_ = std::mt19937(seed_);
 			random_letter_dist_ = std::uniform_real_distribution<float>{0.f, letter_weights_.back()};
 
 			person_score_ = 0;
@@ -337,11 +604,25 @@ namespace halfred {
 			return std::upper_bound(letter_weights_.begin(), letter_weights_.end(), random_letter_dist_(random_bit_gen_)) - letter_weights_.begin();
 		}
 
-		// Randomly select tiles to be added to available letters.
-		void draw_letters(letter_tally& counts, const unsigned int n) {
+		// Randomly select tiles to be added to available letters. Returns the tiles selected.
+		letter_tally draw_letters(letter_tally& counts, const unsigned int n) {
+			letter_tally drawn{};
 			for (unsigned int i = 0; i < n; ++i) {
-				++counts.at(random_letter_as_index());
+				const unsigned int letter_as_index = random_letter_as_index();
+				++counts.at(letter_as_index);
+				++drawn.at(letter_as_index);
 			}
+			return drawn;
+		}
+
+		// Append a record of a play to the log, if there is one. Each record is a line of the form
+		// <player> <location> <word> <letters used> <tiles drawn> <score>
+		// where the player is 'p' for the person or 'h' for Halfred.
+		void log_play(char player, const play& p, const letter_tally& drawn) {
+			if (log_ == nullptr) {
+				return;
+			}
+			*log_ << player << ' ' << location_string(p) << ' ' << p.word << ' ' << tally_string(p.letters_used) << ' ' << tally_string(drawn) << ' ' << p.score << std::endl;
 		}
 
 		// Get a location from the player that could be valid (depending on the board dimension).
@@ -361,10 +642,10 @@ namespace halfred {
 
 		// Find the best valid play anywhere on the board.
 		play best_overall() {
-			play best_option = null_play;
+			candidate best_option = null_candidate;
 			for (size_type row_i = 0; row_i < board_dimension_; ++row_i) {
 				// Best in row.
-				play option = best_in_row(row_i, true);
+				candidate option = best_in_row(row_i, true);
 				if (option.score > best_option.score) {
 					best_option = option;
 				}
@@ -374,60 +655,87 @@ namespace halfred {
 					best_option = option;
 				}
 			}
-			return best_option;
+			if (best_option.score < 0) {
+				return null_play;
+			}
+			return to_play(best_option);
 		}
 
 		// Determine and return the best possible valid play in a row.
 		// is_row = false for a column.
-		play best_in_row(size_type row_index, bool is_row = true) {
-			std::vector<char> board_row;
-			if (is_row) {
-				board_row = board_.at(row_index);
-			}
-			else {
-				board_row.reserve(board_dimension_);
-				for (size_type row_i = 0; row_i < board_dimension_; ++row_i) {
-					board_row.push_back(board_.at(row_i).at(row_index));
+		candidate best_in_row(size_type row_index, bool is_row = true) {
+			candidate best_option = null_candidate;
+			plays_in_row(row_index, is_row, [&best_option](const candidate& c) {
+				if (c.score > best_option.score) {
+					best_option = c;
 				}
-			}
-			std::map<size_type, char> row_letters{};
-			for (unsigned int i = 0; i < board_dimension_; ++i) {
-				if (board_row.at(i) != empty) {
-					row_letters.emplace(i, board_row.at(i));
+			});
+			return best_option;
+		}
+
+		// Pass every valid play in a row to consider.
+		// is_row = false for a column.
+		template <typename Consider>
+		void plays_in_row(size_type row_index, bool is_row, Consider&& consider) {
+			// The letters already in the row, in order, and their positions.
+			std::array<char, max_board_dimension> row_letters;
+			std::array<size_type, max_board_dimension> row_letter_indexes;
+			size_type row_letter_count = 0;
+			for (size_type i = 0; i < board_dimension_; ++i) {
+				const char cell = is_row ? board_.at(row_index).at(i) : board_.at(i).at(row_index);
+				if (cell != empty) {
+					row_letters.at(row_letter_count) = cell;
+					row_letter_indexes.at(row_letter_count) = i;
+					++row_letter_count;
 				}
 			}
 
-			play best_option = null_play;
-			for (const std::string& word : valid_words_) {
-				for (const auto& index_letter : row_letters) {
-					std::string::size_type pos = word.find(index_letter.second);
+			// The most of each letter a word in this row could use: Halfred's tiles plus the letters already in the row.
+			letter_tally reachable_letter_counts = hal_available_letter_counts_;
+			for (size_type letter_i = 0; letter_i < row_letter_count; ++letter_i) {
+				++reachable_letter_counts.at(letter_to_index(row_letters.at(letter_i)));
+			}
+
+			for (size_type word_i = 0; word_i < lexicon_->size(); ++word_i) {
+				if (!lexicon_->could_spell(word_i, reachable_letter_counts)) {
+					continue;
+				}
+				const std::string& word = lexicon_->word(word_i);
+				for (size_type letter_i = 0; letter_i < row_letter_count; ++letter_i) {
+					const size_type letter_index = row_letter_indexes.at(letter_i);
+					std::string::size_type pos = word.find(row_letters.at(letter_i));
 					while (pos != std::string::npos) {
-						auto word_start = board_row.begin() + index_letter.first - pos;
-						auto word_end = word_start + word.size();
-						if (word_start >= board_row.begin() && word_start < board_row.end() && word_end <= board_row.end()) {
-							play p = null_play;
-							p.word = word;
+						// The word must start and end within the row.
+						if (pos <= letter_index && letter_index - pos + word.size() <= board_dimension_) {
+							const size_type word_start = letter_index - pos;
+							candidate c = null_candidate;
+							c.word_index = word_i;
+							c.across = is_row;
 							if (is_row) {
-								p.row = row_index;
-								p.col = index_letter.first;
+								c.row = row_index;
+								c.col = word_start;
 							}
 							else {
-								p.row = index_letter.first;
-								p.col = row_index;
+								c.row = word_start;
+								c.col = row_index;
 							}
-							evaluate_play(p, hal_available_letter_counts_);
-							if (p.score > best_option.score) {
-								best_option = p;
+							score_play(c, word_i, hal_available_letter_counts_);
+							if (c.score >= 0) {
+								consider(c);
 							}
 						}
-						pos = word.find(index_letter.second, pos + 1);
+						pos = word.find(row_letters.at(letter_i), pos + 1);
 					}
 				}
 			}
-			return best_option;
 		}
 
-		void apply_play(play& p, letter_tally& available_letter_counts, unsigned int& score) {
+		play to_play(const candidate& c) const {
+			return play{c.row, c.col, c.across, lexicon_->word(c.word_index), c.score, c.letters_used};
+		}
+
+		// Returns the tiles drawn to replace those used.
+		letter_tally apply_play(play& p, letter_tally& available_letter_counts, unsigned int& score) {
 			for (size_type i = 0; i < letter_space_size + 1; ++i) {
 				available_letter_counts.at(i) -= p.letters_used.at(i);
 			}
@@ -443,50 +751,74 @@ namespace halfred {
 				}
 			}
 			score += p.score;
-			draw_letters(available_letter_counts, std::accumulate(p.letters_used.begin(), p.letters_used.end(), 0));
+			return draw_letters(available_letter_counts, std::accumulate(p.letters_used.begin(), p.letters_used.end(), 0));
 		}
 
 		std::string evaluate_play(play& p, const letter_tally& available_letter_counts) {
-			p.score = 0;
+			const size_type word_index = lexicon_->index_of(p.word);
+			if (word_index == lexicon_->size()) {
+				p.score = -1;
+				return std::string{"\""} + p.word + "\" is not a valid word.";
+			}
+			std::string explanation{};
+			score_play(p, word_index, available_letter_counts, &explanation);
+			return explanation;
+		}
+
+		// Score a play (either a play or a candidate), setting its score to -1 if it is invalid.
+		// Explaining why a play is invalid takes time, so an explanation is only given if one is asked for.
+		template <typename Play>
+		void score_play(Play& p, size_type word_index, const letter_tally& available_letter_counts, std::string* explanation = nullptr) {
+			const std::string& word = lexicon_->word(word_index);
+			const letter_tally& letter_scores = lexicon_->letter_scores();
+			// Start from the score of the whole word, then correct it for any blank tiles used.
+			p.score = lexicon_->word_score(word_index);
 
 			if ((p.across
 				&& ((p.col > 0 && board_.at(p.row).at(p.col - 1) != empty)
-				|| (p.col + p.word.size() < board_dimension_ && board_.at(p.row).at(p.col + p.word.size()) != empty)))
+				|| (p.col + word.size() < board_dimension_ && board_.at(p.row).at(p.col + word.size()) != empty)))
 				|| (!p.across
 				&& ((p.row > 0 && board_.at(p.row - 1).at(p.col) != empty)
-				|| (p.row + p.word.size() < board_dimension_ && board_.at(p.row + p.word.size()).at(p.col) != empty)))) {
+				|| (p.row + word.size() < board_dimension_ && board_.at(p.row + word.size()).at(p.col) != empty)))) {
 				p.score = -1;
-				return "It would be right up against another word in the same dimension, forming a longer possible word with the other word. If this longer word is valid and you want to play it, then enter it.";
+				if (explanation) {
+					*explanation = "It would be right up against another word in the same dimension, forming a longer possible word with the other word. If this longer word is valid and you want to play it, then enter it.";
+				}
+				return;
 			}
 
 			size_type row_i = p.row;
 			size_type col_i = p.col;
 			unsigned int cross_word_count = 0;
-			for (unsigned int word_i = 0; word_i < p.word.size(); ++word_i, p.across ? ++col_i : ++row_i) {
-				size_type letter_as_index = letter_to_index(p.word.at(word_i));
+			std::array<char, max_board_dimension> cross_letters;
+			for (unsigned int word_i = 0; word_i < word.size(); ++word_i, p.across ? ++col_i : ++row_i) {
+				size_type letter_as_index = letter_to_index(word.at(word_i));
 				try {
-					// If the cell already has the required letter.
-					if (board_.at(row_i).at(col_i) == p.word.at(word_i)) {
-						p.score += letter_scores_.at(letter_as_index);
+					// If the cell already has the required letter, the word's score already counts it.
+					if (board_.at(row_i).at(col_i) == word.at(word_i)) {
+						continue;
 					}
 					// If the cell is empty, let's see if we can fill it.
 					else if (board_.at(row_i).at(col_i) == empty) {
 						// Do we have the required letter?
 						if (available_letter_counts.at(letter_as_index) > p.letters_used.at(letter_as_index)) {
 							++p.letters_used.at(letter_as_index);
-							p.score += letter_scores_.at(letter_as_index);
 						}
 						// Can we use a blank tile?
 						else if (available_letter_counts.back() > p.letters_used.back()) {
 							++p.letters_used.back();
-							p.score += letter_scores_.back();
+							p.score -= static_cast<int>(letter_scores.at(letter_as_index)) - static_cast<int>(letter_scores.back());
 						}
 						else {
 							p.score = -1;
-							return std::string{"You do not have enough "} + p.word.at(word_i) + "'s to play it there.";
+							if (explanation) {
+								*explanation = std::string{"You do not have enough "} + word.at(word_i) + "'s to play it there.";
+							}
+							return;
 						}
 
 						// Check for invalid crosswords.
+						std::string_view cross_word{};
 						if (p.across
 							&& ((row_i > 0 && board_.at(row_i - 1).at(col_i) != empty)
 							|| (row_i < board_dimension_ - 1 && board_.at(row_i + 1).at(col_i) != empty))) {
@@ -498,21 +830,11 @@ namespace halfred {
 							while (cross_word_end < board_dimension_ && board_.at(cross_word_end).at(col_i) != empty) {
 								++cross_word_end;
 							}
-							std::string cross_word{};
 							for (size_type cross_i = cross_word_start; cross_i < cross_word_end; ++cross_i) {
-								cross_word += board_.at(cross_i).at(col_i);
+								cross_letters.at(cross_i - cross_word_start) = board_.at(cross_i).at(col_i);
 							}
-							cross_word.at(row_i - cross_word_start) = p.word.at(word_i);
-							if (std::binary_search(valid_words_.begin(), valid_words_.end(), cross_word)) {
-								for (const char& ch : cross_word) {
-									p.score += letter_scores_.at(letter_to_index(ch));
-								}
-							}
-							else {
-								p.score = -1;
-								return std::string{"Doing so would simultaneously spell the invalid word \""} + cross_word + "\".";
-							}
-							++cross_word_count;
+							cross_letters.at(row_i - cross_word_start) = word.at(word_i);
+							cross_word = std::string_view{cross_letters.data(), cross_word_end - cross_word_start};
 						}
 						// The word is spelled downwards.
 						else if (!p.across
@@ -526,42 +848,59 @@ namespace halfred {
 							while (cross_word_end < board_dimension_ && board_.at(row_i).at(cross_word_end) != empty) {
 								++cross_word_end;
 							}
-							std::string cross_word(board_.at(row_i).begin() + cross_word_start, board_.at(row_i).begin() + cross_word_end);
-							cross_word.at(col_i - cross_word_start) = p.word.at(word_i);
-							if (std::binary_search(valid_words_.begin(), valid_words_.end(), cross_word)) {
-								for (const char& ch : cross_word) {
-									p.score += letter_scores_.at(letter_to_index(ch));
-								}
+							std::copy(board_.at(row_i).begin() + cross_word_start, board_.at(row_i).begin() + cross_word_end, cross_letters.begin());
+							cross_letters.at(col_i - cross_word_start) = word.at(word_i);
+							cross_word = std::string_view{cross_letters.data(), cross_word_end - cross_word_start};
+						}
+
+						if (!cross_word.empty()) {
+							const size_type cross_word_index = lexicon_->index_of(cross_word);
+							if (cross_word_index != lexicon_->size()) {
+								p.score += lexicon_->word_score(cross_word_index);
 							}
 							else {
 								p.score = -1;
-								return std::string{"Doing so would simultaneously spell the invalid word \""} + cross_word + "\".";
+								if (explanation) {
+									*explanation = std::string{"Doing so would simultaneously spell the invalid word \""} + std::string{cross_word} + "\".";
+								}
+								return;
 							}
-						++cross_word_count;
+							++cross_word_count;
 						}
 					}
 					// The cell is already filled with a conflicting letter.
 					else {
 						p.score = -1;
-						return std::string{"The board already has "} + board_.at(row_i).at(col_i) + " where you want to put " + p.word.at(word_i) + ".";
+						if (explanation) {
+							*explanation = std::string{"The board already has "} + board_.at(row_i).at(col_i) + " where you want to put " + word.at(word_i) + ".";
+						}
+						return;
 					}
 				}
 				catch (std::out_of_range) {
 					p.score = -1;
-					return "Some part of the word would be beyond the edges of the board.";
+					if (explanation) {
+						*explanation = "Some part of the word would be beyond the edges of the board.";
+					}
+					return;
 				}
 			}
 			if (std::none_of(p.letters_used.begin(), p.letters_used.end(), [](auto k){return k > 0;})) {
 				p.score = -1;
-				return "The word is already on the board in that position. You wouldn't be adding anything to it.";
+				if (explanation) {
+					*explanation = "The word is already on the board in that position. You wouldn't be adding anything to it.";
+				}
+				return;
 			}
 			// If a play has no crosswords and there are already words on the board, the play being evaluated is not connected to any words already on the board, and is therefore invalid.
 			if (cross_word_count == 0 && board_occupied_count() > 1) {
 				p.score = -1;
-				return "It would not be touching any other words already on the board.";
+				if (explanation) {
+					*explanation = "It would not be touching any other words already on the board.";
+				}
+				return;
 			}
 			// The only happy exit.
-			return "";
 		}
 
 		std::stringstream& output_column_indexes(std::stringstream& out) const {
@@ -580,7 +919,7 @@ namespace halfred {
 				return;
 			}
 			p.word = clean_word(p.word);
-			if (p.word.empty() || !std::binary_search(valid_words_.begin(), valid_words_.end(), p.word)) {
+			if (p.word.empty() || lexicon_->index_of(p.word) == lexicon_->size()) {
 				out << "Invalid word. Be sure to use only lowercase English letters. If you are unable to spell any more words, type \"_\" (an underscore) to end the game." << std::endl;
 				get_word(p, in, out);
 			}
@@ -616,8 +955,7 @@ namespace halfred {
 	}
 
 	void swap(Game& first, Game& second) {
-		std::swap(first.valid_words_, second.valid_words_);
-		std::swap(first.letter_scores_, second.letter_scores_);
+		std::swap(first.lexicon_, second.lexicon_);
 		std::swap(first.board_dimension_, second.board_dimension_);
 		std::swap(first.verbose_, second.verbose_);
 		std::swap(first.board_, second.board_);
@@ -626,11 +964,26 @@ namespace halfred {
 		std::swap(first.hal_available_letter_counts_, second.hal_available_letter_counts_);
 		std::swap(first.person_score_, second.person_score_);
 		std::swap(first.hal_score_, second.hal_score_);
-		// random_dev_ is omitted here because std::random_device is not swappable.
+		std::swap(first.log_, second.log_);
+		std::swap(first.seed_, second.seed_);
+		// random_dev_ and turn_arena_ are omitted here because neither is swappable.
 		std::swap(first.random_bit_gen_, second.random_bit_gen_);
 		std::swap(first.random_letter_dist_, second.random_letter_dist_);
 	}
 
+	std::string Game::location_string(const play& p) {
+		return std::to_string(p.row + 1) + Game::index_to_letter(p.col) + (p.across ? 'a' : 'd');
+	}
+
+	// Spell out a tally's letters in alphabetical order (blanks last), or "-" if it is empty.
+	std::string Game::tally_string(const letter_tally& tally) {
+		std::string letters{};
+		for (size_type i = 0; i < Game::letter_space_size + 1; ++i) {
+			letters.append(tally.at(i), Game::index_to_letter(i));
+		}
+		return letters.empty() ? "-" : letters;
+	}
+
 	std::string Game::clean_word(std::string word) {
 		for (char& ch : word) {
 			ch = lower(ch);
@@ -642,9 +995,8 @@ namespace halfred {
 		return word;
 	}
 
-	int play_game(std::string valid_words_path, std::string letter_scores_path = "", size_type board_dimension = 16, bool verbose = false, std::istream& in = std::cin, std::ostream& out = std::cout) {
-		StreamHandler{in};
-		StreamHandler{out};
+	// Read the words that fit on a board of the given dimension from a file.
+	std::vector<std::string> read_valid_words(const std::string& valid_words_path, size_type board_dimension) {
 		std::ifstream valid_words_file = defensively_open(valid_words_path);
 		StreamHandler{valid_words_file};
 		std::vector<std::string> valid_words{};
@@ -655,24 +1007,51 @@ namespace halfred {
 				valid_words.push_back(word);
 			}
 		}
+		return valid_words;
+	}
+
+	// Read one score per letter from a file. Returns false (after reporting the problem) if there are too few.
+	bool read_letter_scores(const std::string& letter_scores_path, Game::letter_tally& letter_scores, std::ostream& out = std::cout) {
+		std::ifstream letter_scores_file = defensively_open(letter_scores_path);
+		StreamHandler{letter_scores_file};
+		for (size_type i = 0; i < Game::letter_space_size; ++i) {
+			letter_scores_file >> letter_scores.at(i);
+			if (!letter_scores_file) {
+				out << "Error: " << letter_scores_path << " contains fewer than " << Game::letter_space_size << " letter scores." << std::endl;
+				return false;
+			}
+		}
+		// Blank tiles are worth nothing.
+		letter_scores.back() = 0;
+		return true;
+	}
+
+	// If log_path is not empty, every play is appended to that file so that the game can be replayed with replay_games.
+	int play_game(std::string valid_words_path, std::string letter_scores_path = "", size_type board_dimension = 16, bool verbose = false, std::optional<Game::seed_type> seed = std::nullopt, std::string log_path = "", std::istream& in = std::cin, std::ostream& out = std::cout) {
+		StreamHandler{in};
+		StreamHandler{out};
+		std::vector<std::string> valid_words = read_valid_words(valid_words_path, board_dimension);
 
 		Game game;
 		// If the user chose to not provide letter scores explicitly.
 		if (letter_scores_path.empty()) {
-			game = Game{valid_words, board_dimension, verbose};
+			game = Game{valid_words, board_dimension, verbose, seed};
 		}
 		else {
-			std::ifstream letter_scores_file = defensively_open(letter_scores_path);
-			StreamHandler{letter_scores_file};
 			Game::letter_tally letter_scores;
-			for (unsigned int& score : letter_scores) {
-				letter_scores_file >> score;
-				if (!letter_scores_file) {
-					out << "Error: " << letter_scores_path << " contains fewer than " << Game::letter_space_size << " letter scores." << std::endl;
-					return 1;
-				}
+			if (!read_letter_scores(letter_scores_path, letter_scores, out)) {
+				return 1;
+			}
+			game = Game{valid_words, letter_scores, board_dimension, verbose, seed};
+		}
+
+		std::ofstream log_file;
+		if (!log_path.empty()) {
+			log_file.open(log_path, std::ios::app);
+			if (!log_file.is_open()) {
+				throw std::runtime_error{std::string{"Unable to open "} + log_path + "."};
 			}
-			game = Game{valid_words, letter_scores, board_dimension, verbose};
+			game.start_log(log_file);
 		}
 
 		out << game.game_state();
@@ -700,4 +1079,231 @@ namespace halfred {
 		}
 		return 0;
 	}
+
+	// Describe the best plays for one line of a positions file: a board, a rack, and optionally a lexicon id.
+	// games holds one lazily constructed Game per lexicon so that each worker thread can reuse its own.
+	std::string analyse_position(const std::string& line, std::vector<std::unique_ptr<Game>>& games, const std::vector<std::shared_ptr<const Game::Lexicon>>& lexicons, size_type board_dimension, size_type top_count) {
+		std::istringstream fields{line};
+		std::string board;
+		std::string rack;
+		if (!(fields >> board >> rack)) {
+			return "\terror: Expected a board and a rack.";
+		}
+		size_type lexicon_id = 0;
+		if (!(fields >> std::ws).eof() && (!(fields >> lexicon_id) || lexicon_id >= lexicons.size())) {
+			return "\terror: Unknown lexicon id.";
+		}
+
+		std::unique_ptr<Game>& game = games.at(lexicon_id);
+		if (!game) {
+			game = std::make_unique<Game>(lexicons.at(lexicon_id), board_dimension, false);
+		}
+		std::string possible_error = game->load_position(board, rack);
+		if (!possible_error.empty()) {
+			return "\terror: " + possible_error;
+		}
+
+		std::string result{};
+		for (const Game::play& p : game->best_plays(top_count)) {
+			result += '\t' + p.word + ' ' + Game::location_string(p) + ' ' + std::to_string(p.score);
+		}
+		return result;
+	}
+
+	// Analyse every position in a file (or standard input, if the path is "-"), writing one line of results per position in input order.
+	// Positions are analysed in parallel, but only a bounded window of them is held in memory at once, so files of any length can be streamed.
+	// Problems with the setup are reported to std::cerr, so that out only ever receives results.
+	int analyse_positions(std::vector<std::string> valid_words_paths, std::string positions_path, std::string letter_scores_path = "", size_type board_dimension = 16, size_type top_count = 5, unsigned int thread_count = 0, std::ostream& out = std::cout) {
+		if (board_dimension > Game::max_board_dimension) {
+			std::cerr << "Error: The board dimension cannot be greater than " << Game::max_board_dimension << "." << std::endl;
+			return 1;
+		}
+		std::optional<Game::letter_tally> letter_scores{};
+		if (!letter_scores_path.empty()) {
+			letter_scores.emplace();
+			if (!read_letter_scores(letter_scores_path, *letter_scores, std::cerr)) {
+				return 1;
+			}
+		}
+		// Each lexicon is built once and shared by every worker thread.
+		std::vector<std::shared_ptr<const Game::Lexicon>> lexicons{};
+		for (const std::string& path : valid_words_paths) {
+			lexicons.push_back(std::make_shared<const Game::Lexicon>(read_valid_words(path, board_dimension), letter_scores));
+		}
+
+		std::ifstream positions_file;
+		if (positions_path != "-") {
+			positions_file = defensively_open(positions_path);
+		}
+		std::istream& in = positions_path == "-" ? std::cin : positions_file;
+
+		if (thread_count == 0) {
+			thread_count = std::max(std::thread::hardware_concurrency(), 1U);
+		}
+
+		struct slot {
+			unsigned long line_number;
+			std::string line;
+			std::string result;
+			bool done;
+		};
+		// Positions that have been read but whose results have not yet been written.
+		std::vector<slot> window(thread_count * 16);
+		std::mutex window_mutex;
+		std::condition_variable work_ready;
+		std::condition_variable result_ready;
+		std::condition_variable slot_free;
+		unsigned long read_count = 0;
+		unsigned long claimed_count = 0;
+		unsigned long written_count = 0;
+		bool input_done = false;
+
+		auto analyse = [&]() {
+			std::vector<std::unique_ptr<Game>> games(lexicons.size());
+			while (true) {
+				std::unique_lock<std::mutex> lock{window_mutex};
+				work_ready.wait(lock, [&]{return claimed_count < read_count || input_done;});
+				if (claimed_count == read_count) {
+					return;
+				}
+				slot& s = window.at(claimed_count++ % window.size());
+				std::string line = std::move(s.line);
+				lock.unlock();
+
+				std::string result;
+				try {
+					result = analyse_position(line, games, lexicons, board_dimension, top_count);
+				}
+				catch (const std::exception& e) {
+					result = std::string{"\terror: "} + e.what();
+				}
+
+				lock.lock();
+				s.result = std::move(result);
+				s.done = true;
+				lock.unlock();
+				result_ready.notify_one();
+			}
+		};
+
+		auto write = [&]() {
+			while (true) {
+				std::unique_lock<std::mutex> lock{window_mutex};
+				result_ready.wait(lock, [&]{return (written_count < read_count && window.at(written_count % window.size()).done) || (input_done && written_count == read_count);});
+				if (written_count == read_count) {
+					return;
+				}
+				slot& s = window.at(written_count % window.size());
+				unsigned long line_number = s.line_number;
+				std::string result = std::move(s.result);
+				s.done = false;
+				++written_count;
+				lock.unlock();
+				slot_free.notify_one();
+				out << line_number << result << '\n';
+			}
+		};
+
+		std::vector<std::thread> workers{};
+		for (unsigned int i = 0; i < thread_count; ++i) {
+			workers.emplace_back(analyse);
+		}
+		std::thread writer{write};
+
+		std::string line;
+		unsigned long line_number = 0;
+		while (std::getline(in, line)) {
+			++line_number;
+			// Skip blank lines.
+			if (line.find_first_not_of(" \t\r") == std::string::npos) {
+				continue;
+			}
+			std::unique_lock<std::mutex> lock{window_mutex};
+			slot_free.wait(lock, [&]{return read_count - written_count < window.size();});
+			window.at(read_count % window.size()) = slot{line_number, std::move(line), "", false};
+			++read_count;
+			lock.unlock();
+			work_ready.notify_one();
+		}
+		{
+			std::lock_guard<std::mutex> lock{window_mutex};
+			input_done = true;
+		}
+		work_ready.notify_all();
+		result_ready.notify_one();
+
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+		writer.join();
+		out << std::flush;
+		return 0;
+	}
+
+	// Replay logged games (see Game::start_log) as fast as possible, without prompting anyone.
+	// Each of Halfred's logged plays is compared with the play the reference generator would choose now (unless the reference is none).
+	// Every difference from a log is reported, and 1 is returned if there were any.
+	int replay_games(std::string valid_words_path, std::vector<std::string> log_paths, std::string letter_scores_path = "", Game::move_generator reference = Game::move_generator::best_overall, std::ostream& out = std::cout) {
+		StreamHandler{out};
+		std::optional<Game::letter_tally> letter_scores{};
+		if (!letter_scores_path.empty()) {
+			letter_scores.emplace();
+			if (!read_letter_scores(letter_scores_path, *letter_scores, out)) {
+				return 1;
+			}
+		}
+		// Which words are valid depends on the board dimension, so keep a lexicon for each dimension seen.
+		std::map<size_type, std::shared_ptr<const Game::Lexicon>> lexicons_by_dimension{};
+
+		unsigned long total_difference_count = 0;
+		for (const std::string& log_path : log_paths) {
+			std::ifstream log_file = defensively_open(log_path);
+			// A log may hold several games, each starting with a header line holding its seed and board dimension.
+			std::unique_ptr<Game> game{};
+			unsigned long game_count = 0;
+			unsigned long play_count = 0;
+			unsigned long difference_count = 0;
+			std::chrono::duration<double, std::milli> elapsed{0};
+			std::string record;
+			unsigned long line_number = 0;
+			while (std::getline(log_file, record)) {
+				++line_number;
+				if (record.empty()) {
+					continue;
+				}
+				if (std::isdigit(static_cast<unsigned char>(record.front()))) {
+					std::istringstream header{record};
+					Game::seed_type seed;
+					size_type board_dimension;
+					if (!(header >> seed >> board_dimension) || board_dimension > Game::max_board_dimension) {
+						out << "Error: " << log_path << ":" << line_number << " is not a valid seed and board dimension." << std::endl;
+						return 1;
+					}
+					std::shared_ptr<const Game::Lexicon>& lexicon = lexicons_by_dimension[board_dimension];
+					if (!lexicon) {
+						lexicon = std::make_shared<const Game::Lexicon>(read_valid_words(valid_words_path, board_dimension), letter_scores);
+					}
+					game = std::make_unique<Game>(lexicon, board_dimension, false, seed);
+					++game_count;
+					continue;
+				}
+				if (!game) {
+					out << "Error: " << log_path << " does not start with a seed and board dimension." << std::endl;
+					return 1;
+				}
+
+				++play_count;
+				const auto start = std::chrono::steady_clock::now();
+				std::string differences = game->replay(record, reference);
+				elapsed += std::chrono::steady_clock::now() - start;
+				if (!differences.empty()) {
+					++difference_count;
+					out << log_path << ":" << line_number << ": " << differences << std::endl;
+				}
+			}
+			out << log_path << ": replayed " << game_count << " games (" << play_count << " plays) in " << elapsed.count() << " ms with " << difference_count << " differences." << std::endl;
+			total_difference_count += difference_count;
+		}
+		return total_difference_count > 0 ? 1 : 0;
+	}
 }